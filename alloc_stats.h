@@ -0,0 +1,286 @@
+#pragma once
+
+// Opt-in allocation and memory-footprint instrumentation.
+//
+// Build with -DALLOC_STATS to replace the global operator new/delete. Every allocation is then
+// charged to the innermost alloc_stats::Phase open on the calling thread, and a sampler thread
+// tracks RSS while phases are open. Without ALLOC_STATS, Phase still times the phase and counts
+// rows, so the same report shows throughput; the allocation columns are blank.
+//
+// A free is charged to the phase current on the freeing thread, not the one that allocated.
+// Memory handed across phases (e.g. rows built in bitcoin_loader's parse and released by the
+// writer after copy) therefore shows as positive net MB in one phase and negative in the other.
+//
+// The operator replacements are defined here, so include this header from exactly one
+// translation unit per program (each driver in this repo is a single .cpp).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#ifdef ALLOC_STATS
+#include <malloc.h>
+#endif
+
+namespace alloc_stats {
+
+constexpr int MAX_PHASES = 64;
+
+struct PhaseCounters {
+    const char *name = nullptr;
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<int64_t> live_bytes{0}; // allocated minus freed while the phase was current
+    std::atomic<uint64_t> rows{0};
+    std::atomic<int64_t> elapsed_ns{0};
+    std::atomic<int> open{0};           // scopes currently open on any thread
+    std::atomic<int64_t> peak_rss{0};   // highest RSS sampled while open
+};
+
+struct State {
+    PhaseCounters phases[MAX_PHASES]; // [0] = outside any phase
+    std::atomic<int> count{1};
+    std::mutex mutex;
+};
+
+inline State &state() {
+    static State s;
+    return s;
+}
+
+inline thread_local int current_phase = 0;
+
+inline bool enabled() {
+#ifdef ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Resident set size from /proc/self/statm, without allocating.
+inline int64_t rss_bytes() {
+    FILE *f = std::fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    long pages = 0, resident = 0;
+    int n = std::fscanf(f, "%ld %ld", &pages, &resident);
+    std::fclose(f);
+    return n == 2 ? static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE) : 0;
+}
+
+// Process-wide peak RSS (VmHWM).
+inline int64_t peak_rss_bytes() {
+    FILE *f = std::fopen("/proc/self/status", "r");
+    if (!f)
+        return 0;
+    char line[256];
+    long kb = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        if (std::strncmp(line, "VmHWM:", 6) == 0) {
+            kb = std::strtol(line + 6, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(f);
+    return static_cast<int64_t>(kb) * 1024;
+}
+
+inline int phase_id(const char *name) {
+    State &s = state();
+    int n = s.count.load(std::memory_order_acquire);
+    for (int i = 1; i < n; ++i) {
+        if (s.phases[i].name == name || std::strcmp(s.phases[i].name, name) == 0)
+            return i;
+    }
+    std::lock_guard<std::mutex> lock(s.mutex);
+    n = s.count.load();
+    for (int i = 1; i < n; ++i) {
+        if (std::strcmp(s.phases[i].name, name) == 0)
+            return i;
+    }
+    if (n == MAX_PHASES)
+        return 0;
+    s.phases[n].name = name;
+    s.count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+inline void on_alloc(size_t size) {
+    PhaseCounters &p = state().phases[current_phase];
+    p.allocs.fetch_add(1, std::memory_order_relaxed);
+    p.bytes.fetch_add(size, std::memory_order_relaxed);
+    p.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+inline void on_free(size_t size) {
+    state().phases[current_phase].live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+// Samples RSS every `interval` and raises peak_rss of every phase that is open at the time.
+class RssSampler {
+public:
+    explicit RssSampler(std::chrono::milliseconds interval = std::chrono::milliseconds(10)) {
+        if (!enabled())
+            return;
+        thread_ = std::thread([this, interval] {
+            while (!stop_.load()) {
+                int64_t rss = rss_bytes();
+                State &s = state();
+                int n = s.count.load(std::memory_order_acquire);
+                for (int i = 1; i < n; ++i) {
+                    PhaseCounters &p = s.phases[i];
+                    if (p.open.load(std::memory_order_relaxed) > 0 && rss > p.peak_rss.load(std::memory_order_relaxed))
+                        p.peak_rss.store(rss, std::memory_order_relaxed);
+                }
+                std::this_thread::sleep_for(interval);
+            }
+        });
+    }
+    ~RssSampler() {
+        stop_.store(true);
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+private:
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+// Charges allocations on this thread to `name` until destroyed; phases nest.
+class Phase {
+public:
+    explicit Phase(const char *name, uint64_t rows = 0)
+        : id_(phase_id(name)), prev_(current_phase), start_(std::chrono::steady_clock::now()) {
+        PhaseCounters &p = state().phases[id_];
+        p.rows.fetch_add(rows, std::memory_order_relaxed);
+        if (p.open.fetch_add(1, std::memory_order_relaxed) == 0 && enabled()) {
+            int64_t rss = rss_bytes();
+            if (rss > p.peak_rss.load(std::memory_order_relaxed))
+                p.peak_rss.store(rss, std::memory_order_relaxed);
+        }
+        current_phase = id_;
+    }
+    ~Phase() {
+        PhaseCounters &p = state().phases[id_];
+        p.elapsed_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count(), std::memory_order_relaxed);
+        p.open.fetch_sub(1, std::memory_order_relaxed);
+        current_phase = prev_;
+    }
+    void add_rows(uint64_t rows) { state().phases[id_].rows.fetch_add(rows, std::memory_order_relaxed); }
+
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+
+private:
+    int id_;
+    int prev_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// One line per phase, heaviest allocator first. Nested phases are reported exclusively, so
+// a parent's numbers exclude what its children allocated. Elapsed time is wall time summed
+// over all threads that opened the phase.
+inline void report(std::ostream &out) {
+    State &s = state();
+    int n = s.count.load();
+    std::vector<int> order;
+    for (int i = 0; i < n; ++i)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return s.phases[a].bytes > s.phases[b].bytes; });
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << "\nMemory / throughput by phase" << (enabled() ? "" : " (build with -DALLOC_STATS for allocation counts)") << "\n"
+        << std::left << std::setw(18) << "phase" << std::right
+        << std::setw(10) << "rows" << std::setw(12) << "rows/s"
+        << std::setw(12) << "allocs" << std::setw(12) << "allocs/row"
+        << std::setw(12) << "MB" << std::setw(12) << "bytes/row"
+        << std::setw(12) << "net MB" << std::setw(14) << "peak RSS MB" << "\n";
+    out << std::fixed;
+    for (int i : order) {
+        const PhaseCounters &p = s.phases[i];
+        uint64_t rows = p.rows.load();
+        uint64_t allocs = p.allocs.load();
+        if (i == 0 && allocs == 0)
+            continue;
+        double secs = p.elapsed_ns.load() / 1e9;
+        out << std::left << std::setw(18) << (i == 0 ? "(no phase)" : p.name) << std::right << std::setprecision(0)
+            << std::setw(10) << rows
+            << std::setw(12) << (secs > 0 && rows ? rows / secs : 0.0);
+        if (enabled()) {
+            out << std::setw(12) << allocs
+                << std::setprecision(1) << std::setw(12) << (rows ? static_cast<double>(allocs) / rows : 0.0)
+                << std::setw(12) << p.bytes.load() / (1024.0 * 1024.0)
+                << std::setprecision(0) << std::setw(12) << (rows ? static_cast<double>(p.bytes.load()) / rows : 0.0)
+                << std::setprecision(1) << std::setw(12) << p.live_bytes.load() / (1024.0 * 1024.0)
+                << std::setw(14) << p.peak_rss.load() / (1024.0 * 1024.0);
+        }
+        out << "\n";
+    }
+    out << "Process peak RSS: " << std::setprecision(1) << peak_rss_bytes() / (1024.0 * 1024.0) << " MB\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace alloc_stats
+
+#ifdef ALLOC_STATS
+// Replacement global allocation functions. Sizes for frees come from malloc_usable_size, which
+// can be slightly larger than the requested size; live bytes are therefore a close approximation.
+// They are kept out of line: once inlined, GCC sees std::free paired with operator new at the
+// call site and warns (-Wmismatched-new-delete) on every delete in the program.
+
+__attribute__((noinline)) void *operator new(size_t size) {
+    void *p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    alloc_stats::on_alloc(malloc_usable_size(p));
+    return p;
+}
+
+__attribute__((noinline)) void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    void *p = std::malloc(size ? size : 1);
+    if (p)
+        alloc_stats::on_alloc(malloc_usable_size(p));
+    return p;
+}
+
+__attribute__((noinline)) void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+    if (!p)
+        return;
+    alloc_stats::on_free(malloc_usable_size(p));
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, size_t) noexcept {
+    operator delete(p);
+}
+#endif
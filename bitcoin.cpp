@@ -2,13 +2,20 @@
 
 #include <ozo/request.h>
 #include <ozo/connection_info.h>
+#include <ozo/connection_pool.h>
 #include <ozo/shortcuts.h>
 #include <boost/asio/io_context.hpp>
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <sstream>
+#include <string>
+#include "ozo_prepared.h"
+#include "workload.h"
 
 namespace asio = boost::asio;
 
@@ -51,13 +58,67 @@ std::ostream &operator<<(std::ostream &os, const BitcoinData &data)
     return os;
 }
 
-int main()
+int main(int argc, char **argv)
 {
     try
     {
+        // --bench N: N runs per measurement, checked before connecting
+        int bench_runs = 0;
+        if (argc > 1 && std::string(argv[1]) == "--bench")
+        {
+            size_t used = 0;
+            try
+            {
+                bench_runs = argc > 2 ? std::stoi(argv[2], &used) : 0;
+            }
+            catch (const std::exception &)
+            {
+            }
+            if (bench_runs <= 0 || argv[2][used] != '\0')
+            {
+                std::cerr << "Usage: " << argv[0] << " [--bench N]   (N > 0 requests per measurement)\n";
+                return 1;
+            }
+        }
+
         asio::io_context io;
         ozo::connection_info conn_info("host=localhost port=5432 dbname=postgres user=postgres password=postgres");
 
+        // Pooled connections keep their prepared statements between requests
+        ozo::connection_pool_config pool_config;
+        pool_config.capacity = 4;
+        pool_config.queue_capacity = 64;
+        pool_config.idle_timeout = std::chrono::seconds(60);
+        auto pool = ozo::make_connection_pool(conn_info, pool_config);
+
+        QueryRepository queries({
+            {"insert_transaction", "bigint, text, text, bigint", "INSERT INTO bitcoin_transactions VALUES ($1, $2, $3, $4)"},
+            {"latest_transaction", "", "SELECT * FROM bitcoin_transactions ORDER BY timestamp DESC LIMIT 1"},
+            {"latest_transactions", "bigint", "SELECT * FROM bitcoin_transactions ORDER BY timestamp DESC LIMIT $1"},
+        });
+        const auto timeout = std::chrono::seconds(30);
+
+        // WORKLOAD_CAPTURE=file records every request below for workload_replay. Requests are all in
+        // flight at once over the pool with no ordering between them, so each one is its own session
+        // and replay can spread them over its connections.
+        std::unique_ptr<workload::Writer> capture;
+        uint32_t next_session = 0;
+        if (const char *capture_file = std::getenv("WORKLOAD_CAPTURE"))
+        {
+            capture = std::make_unique<workload::Writer>(capture_file);
+        }
+        auto capture_insert = [&](const BitcoinData &data)
+        {
+            if (capture)
+            {
+                capture->write(workload::Op::InsertTransaction, next_session++,
+                               {workload::Param::integer(static_cast<int64_t>(data.timestamp)),
+                                workload::Param::text(data.source, true),
+                                workload::Param::text(data.destination, true),
+                                workload::Param::integer(data.satoshi)});
+            }
+        };
+
         // Create Bitcoin table with TimescaleDB hypertable
         auto create_table_query = ozo::make_query(
             "CREATE TABLE IF NOT EXISTS bitcoin_transactions ("
@@ -149,64 +210,38 @@ int main()
         // Single insert function
         auto single_insert = [&](const BitcoinData &data)
         {
-            auto query = ozo::make_query(
-                "INSERT INTO bitcoin_transactions VALUES ($1, $2, $3, $4) ",
-                data.timestamp,
-                data.source,
-                data.destination,
-                data.satoshi);
-
-            ozo::rows_of<> single_insert_res;
-
-            ozo::request(conn_info[io], query,
-                         ozo::deadline(std::chrono::seconds(30)),
-                         ozo::into(single_insert_res),
-                         [](ozo::error_code ec, auto conn)
-                         {
-                             if (ec)
+            capture_insert(data);
+            auto single_insert_res = std::make_shared<ozo::rows_of<>>();
+            request_prepared(queries, pool[io], queries.get("insert_transaction"), timeout,
+                             ozo::into(*single_insert_res),
+                             [single_insert_res](ozo::error_code ec, auto conn)
                              {
-                                 std::cerr << "Single insert error: " << ec.message() << '\n';
-                             }
-                         });
+                                 if (ec)
+                                 {
+                                     std::cerr << "Single insert error: " << ec.message() << '\n';
+                                 }
+                             },
+                             static_cast<int64_t>(data.timestamp), data.source, data.destination, data.satoshi);
         };
 
         // Batch insert function
         auto batch_insert = [&](const std::vector<BitcoinData> &data_batch)
         {
-            // Prepare the batch query
-            auto batch_query = ozo::make_query(
-                "INSERT INTO bitcoin_transactions VALUES ($1, $2, $3, $4)");
-
-            // Prepare the batch parameters
-            std::vector<std::tuple<std::time_t, std::string, std::string, int64_t>> batch_params;
-
-            // Populate batch_params
+            // Every row reuses the plan of the "insert_transaction" statement on its connection
             for (const auto &data : data_batch)
             {
-                batch_params.emplace_back(data.timestamp, data.source, data.destination, data.satoshi);
-            }
-
-            // Execute the batch insert
-            for (const auto &params : batch_params)
-            {
-                auto query = ozo::make_query(
-                    "INSERT INTO bitcoin_transactions VALUES ($1, $2, $3, $4)",
-                    std::get<0>(params),
-                    std::get<1>(params),
-                    std::get<2>(params),
-                    std::get<3>(params));
-
-                ozo::rows_of<> batch_insert_res;
-                ozo::request(conn_info[io], query,
-                             ozo::deadline(std::chrono::seconds(30)),
-                             ozo::into(batch_insert_res),
-                             [](ozo::error_code ec, auto conn)
-                             {
-                                 if (ec)
+                capture_insert(data);
+                auto batch_insert_res = std::make_shared<ozo::rows_of<>>();
+                request_prepared(queries, pool[io], queries.get("insert_transaction"), timeout,
+                                 ozo::into(*batch_insert_res),
+                                 [batch_insert_res](ozo::error_code ec, auto conn)
                                  {
-                                     std::cerr << "x";
-                                 }
-                             });
+                                     if (ec)
+                                     {
+                                         std::cerr << "x";
+                                     }
+                                 },
+                                 static_cast<int64_t>(data.timestamp), data.source, data.destination, data.satoshi);
             }
             std::cout << "\n";
         };
@@ -231,62 +266,135 @@ int main()
         // Query functions
         auto single_read = [&]()
         {
-            auto query = ozo::make_query("SELECT * FROM bitcoin_transactions ORDER BY timestamp DESC LIMIT 1");
-
-            ozo::rows_of<double, std::string, std::string, int64_t> result;
-            ozo::request(conn_info[io], query,
-                         ozo::deadline(std::chrono::seconds(30)),
-                         ozo::into(result),
-                         [&result](ozo::error_code ec, auto conn)
-                         {
-                             if (!ec && !result.empty())
-                             {
-                                 const auto &row = result[0];
-                                 std::cout << "\nLatest entry:\n"
-                                           << "Time: " << std::get<0>(row) << "\t"
-                                           << "Source wallet: " << std::get<1>(row) << "\t"
-                                           << "Destination wallet: " << std::get<2>(row) << "\t"
-                                           << "Satoshis: " << std::get<3>(row) << "\n";
-                             }
-                             else if (ec)
-                             {
-                                 std::cerr << "Single read error: " << ec.message() << '\n';
-                             }
-                         });
-        };
-
-        auto batch_read = [&](int limit)
-        {
-            auto query = ozo::make_query("SELECT * FROM bitcoin_transactions ORDER BY timestamp DESC LIMIT $1", limit);
-
-            ozo::rows_of<double, std::string, std::string, int64_t> result;
-            ozo::request(conn_info[io], query,
-                         ozo::deadline(std::chrono::seconds(30)),
-                         ozo::into(result),
-                         [&result](ozo::error_code ec, auto conn)
-                         {
-                             if (!ec)
+            if (capture)
+            {
+                capture->write(workload::Op::LatestTransactions, next_session++, {workload::Param::integer(1)});
+            }
+            auto result = std::make_shared<ozo::rows_of<int64_t, std::string, std::string, int64_t>>();
+            request_prepared(queries, pool[io], queries.get("latest_transaction"), timeout,
+                             ozo::into(*result),
+                             [result](ozo::error_code ec, auto conn)
                              {
-                                 std::cout << "\nBatch read results:\n";
-                                 for (const auto &row : result)
+                                 if (!ec && !result->empty())
                                  {
-                                     std::cout << "Time: " << std::get<0>(row) << "\t"
+                                     const auto &row = (*result)[0];
+                                     std::cout << "\nLatest entry:\n"
+                                               << "Time: " << std::get<0>(row) << "\t"
                                                << "Source wallet: " << std::get<1>(row) << "\t"
                                                << "Destination wallet: " << std::get<2>(row) << "\t"
                                                << "Satoshis: " << std::get<3>(row) << "\n";
                                  }
-                             }
-                             else
+                                 else if (ec)
+                                 {
+                                     std::cerr << "Single read error: " << ec.message() << '\n';
+                                 }
+                             });
+        };
+
+        auto batch_read = [&](int64_t limit)
+        {
+            if (capture)
+            {
+                capture->write(workload::Op::LatestTransactions, next_session++, {workload::Param::integer(limit)});
+            }
+            auto result = std::make_shared<ozo::rows_of<int64_t, std::string, std::string, int64_t>>();
+            request_prepared(queries, pool[io], queries.get("latest_transactions"), timeout,
+                             ozo::into(*result),
+                             [result](ozo::error_code ec, auto conn)
                              {
-                                 std::cerr << "Batch read error: " << ec.message() << '\n';
-                             }
-                         });
+                                 if (!ec)
+                                 {
+                                     std::cout << "\nBatch read results:\n";
+                                     for (const auto &row : *result)
+                                     {
+                                         std::cout << "Time: " << std::get<0>(row) << "\t"
+                                                   << "Source wallet: " << std::get<1>(row) << "\t"
+                                                   << "Destination wallet: " << std::get<2>(row) << "\t"
+                                                   << "Satoshis: " << std::get<3>(row) << "\n";
+                                     }
+                                 }
+                                 else
+                                 {
+                                     std::cerr << "Batch read error: " << ec.message() << '\n';
+                                 }
+                             },
+                             limit);
         };
 
         // Execute queries
         single_read();
         batch_read(5);
         io.run();
+        io.restart();
+
+        // ./bitcoin --bench N: plain ozo::make_query (binary $n parameters, parsed and planned per call)
+        // vs request_prepared (EXECUTE with text literals, cached plan), same pool, one request in flight.
+        // The difference includes parameter encoding as well as plan reuse.
+        if (bench_runs > 0 && !batch.empty())
+        {
+            const int runs = bench_runs;
+
+            auto measure = [&](const char *label, auto &&issue)
+            {
+                int errors = 0;
+                std::chrono::microseconds total{0};
+                for (int i = 0; i < runs; ++i)
+                {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    issue(i, errors);
+                    io.run();
+                    io.restart();
+                    total += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+                }
+                std::cout << label << ": avg " << static_cast<double>(total.count()) / runs << " us, "
+                          << runs * 1e6 / std::max<int64_t>(total.count(), 1) << " ops/s, "
+                          << errors << " errors\n";
+            };
+
+            auto on_done = [](int &errors)
+            {
+                return [&errors](ozo::error_code ec, auto conn)
+                {
+                    if (ec)
+                        ++errors;
+                };
+            };
+
+            std::cout << "\nPrepared statement benchmark (" << runs << " runs each): unprepared = make_query with binary "
+                      << "parameters, prepared = EXECUTE with text literals; measures both together, not plan reuse alone\n";
+            measure("insert, unprepared", [&](int i, int &errors)
+                    {
+                        const auto &data = batch[i % batch.size()];
+                        auto res = std::make_shared<ozo::rows_of<>>();
+                        ozo::request(pool[io],
+                                     ozo::make_query("INSERT INTO bitcoin_transactions VALUES ($1, $2, $3, $4)",
+                                                     static_cast<int64_t>(data.timestamp), data.source, data.destination, data.satoshi),
+                                     ozo::deadline(timeout), ozo::into(*res),
+                                     [res, done = on_done(errors)](ozo::error_code ec, auto conn) mutable { done(ec, std::move(conn)); });
+                    });
+            measure("insert, prepared  ", [&](int i, int &errors)
+                    {
+                        const auto &data = batch[i % batch.size()];
+                        auto res = std::make_shared<ozo::rows_of<>>();
+                        request_prepared(queries, pool[io], queries.get("insert_transaction"), timeout, ozo::into(*res),
+                                         [res, done = on_done(errors)](ozo::error_code ec, auto conn) mutable { done(ec, std::move(conn)); },
+                                         static_cast<int64_t>(data.timestamp), data.source, data.destination, data.satoshi);
+                    });
+            measure("latest, unprepared", [&](int, int &errors)
+                    {
+                        auto res = std::make_shared<ozo::rows_of<int64_t, std::string, std::string, int64_t>>();
+                        ozo::request(pool[io], ozo::make_query("SELECT * FROM bitcoin_transactions ORDER BY timestamp DESC LIMIT 1"),
+                                     ozo::deadline(timeout), ozo::into(*res),
+                                     [res, done = on_done(errors)](ozo::error_code ec, auto conn) mutable { done(ec, std::move(conn)); });
+                    });
+            measure("latest, prepared  ", [&](int, int &errors)
+                    {
+                        auto res = std::make_shared<ozo::rows_of<int64_t, std::string, std::string, int64_t>>();
+                        request_prepared(queries, pool[io], queries.get("latest_transaction"), timeout, ozo::into(*res),
+                                         [res, done = on_done(errors)](ozo::error_code ec, auto conn) mutable { done(ec, std::move(conn)); });
+                    });
+            std::cout << "PREPAREs issued: " << queries.prepares() << "\n";
+        }
     }
     catch (const std::exception &e)
     {
@@ -1,22 +1,55 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <sstream>
-#include <iomanip>
 #include <string>
 #include <openssl/sha.h>
+#include "row_schema.h"
 
-const size_t RECORD_COUNT = 1048576; // # records
-const size_t COLUMNS = 32;           // total columns (1 timestamp + 31 hash)
-const size_t FIELD_WIDTH = 32;       // each field = 32 bytes
+const size_t RECORD_COUNT = 1048576;                 // # records
+const int64_t START_US = 1577836800LL * 1000000;     // 2020-01-01, one row per second
 
-// Helper function: convert binary data to a hex string.
-std::string to_hex(const unsigned char* data, size_t length) {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < length; i++) {
-        oss << std::setw(2) << static_cast<int>(data[i]);
+// Row layout (column count, types, widths) comes from BlockSchema in row_schema.h.
+using Row = BlockSchema::Row;
+
+// Deterministic pseudo-random bytes for (row, column): SHA-256, chained for fields over 32 bytes.
+void hash_bytes(size_t row, size_t col, unsigned char *out, size_t length) {
+    std::string input = std::to_string(row) + "," + std::to_string(col);
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    for (size_t done = 0, block = 0; done < length; done += SHA256_DIGEST_LENGTH, ++block) {
+        std::string seed = input + ":" + std::to_string(block);
+        SHA256(reinterpret_cast<const unsigned char*>(seed.data()), seed.size(), hash);
+        std::memcpy(out + done, hash, std::min<size_t>(SHA256_DIGEST_LENGTH, length - done));
     }
-    return oss.str();
+}
+
+// One overload per field type in row_schema.h.
+void fill(schema::Timestamp, size_t row, size_t, int64_t &value) {
+    value = START_US + static_cast<int64_t>(row) * 1000000; // unique: it is the primary key
+}
+
+template <typename Int, const char *Sql>
+void fill(schema::Integral<Int, Sql>, size_t row, size_t col, Int &value) {
+    value = static_cast<Int>(row * (col + 1));
+}
+
+void fill(schema::Double, size_t row, size_t col, double &value) {
+    value = row + col / 100.0;
+}
+
+// Hex digits of the hash, like the original 32-character hash columns.
+template <size_t N>
+void fill(schema::FixedChar<N>, size_t row, size_t col, std::array<char, N> &value) {
+    static const char digits[] = "0123456789abcdef";
+    unsigned char bytes[(N + 1) / 2];
+    hash_bytes(row, col, bytes, sizeof(bytes));
+    for (size_t i = 0; i < N; i++)
+        value[i] = digits[i % 2 ? bytes[i / 2] & 0xf : bytes[i / 2] >> 4];
+}
+
+template <size_t N>
+void fill(schema::FixedBinary<N>, size_t row, size_t col, std::array<std::byte, N> &value) {
+    hash_bytes(row, col, reinterpret_cast<unsigned char*>(value.data()), N);
 }
 
 int main() {
@@ -26,42 +59,25 @@ int main() {
         return 1;
     }
 
-    out << "timestamp";
-    // Loop to create headers for columns 1 to 31
-    for (size_t col = 1; col < COLUMNS; col++)
-    {
-        out << ",hash_" << col;
-    }
-    out << "\n";
+    out << BlockSchema::csv_header() << "\n";
 
+    Row row;
+    std::string csvLine;
     for (size_t i = 0; i < RECORD_COUNT; i++) {
-        std::ostringstream csvLine;
-
-        // Column 0: Unique timestamp
-        std::ostringstream tsStream;
-        tsStream << std::setw(FIELD_WIDTH) << std::setfill('0') << std::hex << i;
-        std::string timestamp = tsStream.str();
-        csvLine << timestamp;
-
-        // Columns 1 to 31: Compute SHA-256 hash (truncated to 32 hex characters)
-        for (size_t col = 1; col < COLUMNS; col++) {
-            csvLine << ",";
-            std::string input = timestamp + std::to_string(col);
-
-            unsigned char hash[SHA256_DIGEST_LENGTH];
-            SHA256(reinterpret_cast<const unsigned char*>(input.data()), input.size(), hash);
-
-            std::string hashHex = to_hex(hash, SHA256_DIGEST_LENGTH);
-            csvLine << hashHex.substr(0, FIELD_WIDTH);
-        }
+        BlockSchema::for_each_index([&](auto idx) {
+            constexpr size_t col = decltype(idx)::value;
+            fill(BlockSchema::field_t<col>(), i, col, std::get<col>(row));
+        });
 
-        csvLine << "\n";
-        out << csvLine.str();
+        csvLine.clear();
+        BlockSchema::append_csv(row, csvLine);
+        out << csvLine;
     }
 
     out.close();
-    std::cout << "Created " << RECORD_COUNT << " records in generated.csv" << std::endl;
+    std::cout << "Created " << RECORD_COUNT << " records (" << BlockSchema::column_count
+              << " columns) in generated.csv" << std::endl;
     return 0;
 }
 
-// g++ generator.cpp -lcrypto -o generator
\ No newline at end of file
+// g++ -std=c++17 generator.cpp -lcrypto -o generator
\ No newline at end of file
@@ -0,0 +1,209 @@
+#pragma once
+
+// Client-side group commit for row producers.
+//
+// Producers call submit(row) from any thread and get a future. A few connection threads drain
+// the shared queue: each takes up to max_rows pending rows, or whatever arrived within max_delay
+// of the oldest one, inserts them in one transaction and commits. A producer's future is
+// completed only after the commit that covers its row succeeded, so every acknowledged row is
+// durable (unless synchronous_commit is turned off) while the server sees one commit per batch.
+//
+// If a batch fails, its rows are retried one transaction each so that a single bad row (e.g. a
+// duplicate key) fails only its own future. A commit whose outcome is unknown
+// (pqxx::in_doubt_error) is not retried; every future in the batch gets the error.
+
+#include <pqxx/pqxx>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace group_commit {
+
+struct Options {
+    size_t connections = 4;
+    size_t max_rows = 256;                          // flush when this many rows are pending
+    std::chrono::microseconds max_delay{5000};      // ... or when the oldest has waited this long
+    bool synchronous_commit = true;                 // false: SET synchronous_commit = off per connection
+};
+
+struct Stats {
+    uint64_t commits = 0;
+    uint64_t rows = 0;          // rows acknowledged
+    uint64_t failed_rows = 0;   // futures completed with an exception
+    uint64_t split_batches = 0; // batches retried row by row after a failure
+};
+
+// Schema is a schema::Table (row_schema.h).
+template <typename Schema>
+class Committer {
+public:
+    using Row = typename Schema::Row;
+    using Clock = std::chrono::steady_clock;
+
+    Committer(std::string conn_str, Options opts) : conn_str_(std::move(conn_str)), opts_(opts) {
+        if (opts_.connections == 0 || opts_.max_rows == 0)
+            throw std::invalid_argument("group_commit: connections and max_rows must be positive");
+        // Open every connection up front so a bad connection string fails here, not in a future.
+        std::vector<std::unique_ptr<pqxx::connection>> conns;
+        for (size_t i = 0; i < opts_.connections; ++i)
+            conns.push_back(connect());
+        for (auto &conn : conns)
+            workers_.emplace_back(&Committer::worker, this, std::move(conn));
+    }
+
+    // Commits everything still pending, then stops the connection threads.
+    ~Committer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        cv_.notify_all();
+        for (auto &t : workers_)
+            t.join();
+    }
+
+    Committer(const Committer &) = delete;
+    Committer &operator=(const Committer &) = delete;
+
+    std::future<void> submit(const Row &row) {
+        std::promise<void> done;
+        std::future<void> result = done.get_future();
+        size_t pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_)
+                throw std::logic_error("group_commit: submit after shutdown");
+            queue_.push_back({row, std::move(done), Clock::now()});
+            pending = queue_.size();
+        }
+        if (pending == 1 || pending == opts_.max_rows)
+            cv_.notify_one();
+        return result;
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.commits = commits_.load();
+        s.rows = rows_.load();
+        s.failed_rows = failed_rows_.load();
+        s.split_batches = split_batches_.load();
+        return s;
+    }
+
+private:
+    struct Pending {
+        Row row;
+        std::promise<void> done;
+        Clock::time_point submitted;
+    };
+
+    std::unique_ptr<pqxx::connection> connect() {
+        auto conn = std::make_unique<pqxx::connection>(conn_str_);
+        if (!opts_.synchronous_commit)
+            conn->set_session_var("synchronous_commit", "off");
+        conn->prepare("group_insert", Schema::insert_sql());
+        return conn;
+    }
+
+    // Blocks until a batch is due; returns false once closing and drained.
+    bool next_batch(std::vector<Pending> &batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!closing_ && queue_.size() < opts_.max_rows) {
+            if (queue_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            // Another thread may take the front meanwhile, so recompute the deadline each time.
+            auto deadline = queue_.front().submitted + opts_.max_delay;
+            if (Clock::now() >= deadline)
+                break;
+            cv_.wait_until(lock, deadline);
+        }
+        if (queue_.empty())
+            return false;
+        size_t n = std::min(queue_.size(), opts_.max_rows);
+        for (size_t i = 0; i < n; ++i) {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        // Leftovers may already be due; let another connection pick them up.
+        if (!queue_.empty())
+            cv_.notify_one();
+        return true;
+    }
+
+    void insert(pqxx::connection &conn, typename Schema::Binder &binder, Pending *rows, size_t n) {
+        pqxx::work txn(conn);
+        for (size_t i = 0; i < n; ++i) {
+            binder.encode(rows[i].row);
+            binder.exec_prepared(txn, "group_insert");
+        }
+        txn.commit();
+        commits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void fail(Pending &p, std::exception_ptr error) {
+        p.done.set_exception(error);
+        failed_rows_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void worker(std::unique_ptr<pqxx::connection> conn) {
+        typename Schema::Binder binder;
+        std::vector<Pending> batch;
+        batch.reserve(opts_.max_rows);
+        while (true) {
+            batch.clear();
+            if (!next_batch(batch))
+                return;
+            try {
+                if (!conn->is_open())
+                    conn = connect();
+                insert(*conn, binder, batch.data(), batch.size());
+                for (auto &p : batch)
+                    p.done.set_value();
+                rows_.fetch_add(batch.size(), std::memory_order_relaxed);
+                continue;
+            } catch (const pqxx::in_doubt_error &) {
+                for (auto &p : batch)
+                    fail(p, std::current_exception());
+                continue;
+            } catch (const std::exception &) {
+            }
+
+            split_batches_.fetch_add(1, std::memory_order_relaxed);
+            for (auto &p : batch) {
+                try {
+                    if (!conn->is_open())
+                        conn = connect();
+                    insert(*conn, binder, &p, 1);
+                    p.done.set_value();
+                    rows_.fetch_add(1, std::memory_order_relaxed);
+                } catch (const std::exception &) {
+                    fail(p, std::current_exception());
+                }
+            }
+        }
+    }
+
+    std::string conn_str_;
+    Options opts_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    bool closing_ = false;
+    std::vector<std::thread> workers_;
+    std::atomic<uint64_t> commits_{0}, rows_{0}, failed_rows_{0}, split_batches_{0};
+};
+
+} // namespace group_commit
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <ozo/connection.h>
+#include <ozo/execute.h>
+#include <ozo/request.h>
+#include <ozo/shortcuts.h>
+#include <libpq-fe.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Server-side prepared statements on top of OZO's request path.
+//
+// OZO sends every ozo::make_query as a fresh PQsendQueryParams, so the server parses and plans
+// the statement on each call. Here each named query is PREPAREd once per pooled connection and
+// then run as "EXECUTE name(args)": the server only parses the tiny EXECUTE and reuses the
+// cached plan. Arguments are inlined as SQL literals (see sql_literal) because EXECUTE is a
+// utility statement and cannot take protocol-level $n parameters.
+
+struct PreparedQuery
+{
+    const char *name;        // statement name, must be a valid SQL identifier
+    const char *param_types; // e.g. "bigint, text"; empty for no parameters
+    const char *sql;         // body using $1..$n
+};
+
+inline std::string sql_literal(int64_t v) { return std::to_string(v); }
+inline std::string sql_literal(int32_t v) { return std::to_string(v); }
+
+// NaN and infinities only exist as quoted float8 input strings.
+inline std::string sql_literal(double v)
+{
+    if (std::isnan(v))
+        return "'NaN'::float8";
+    if (std::isinf(v))
+        return v > 0 ? "'Infinity'::float8" : "'-Infinity'::float8";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    return buf;
+}
+
+// E'' form so the result does not depend on standard_conforming_strings.
+inline std::string sql_literal(const std::string &v)
+{
+    std::string out = "E'";
+    out.reserve(v.size() + 3);
+    for (char c : v)
+    {
+        if (c == '\'' || c == '\\')
+            out += c;
+        out += c;
+    }
+    out += '\'';
+    return out;
+}
+
+inline std::string sql_literal(const char *v) { return sql_literal(std::string(v)); }
+
+inline std::string sql_literal(std::chrono::system_clock::time_point tp)
+{
+    using namespace std::chrono;
+    auto us = duration_cast<microseconds>(tp.time_since_epoch()).count();
+    // Floor division so times before 1970 get a non-negative fraction.
+    long long frac = us % 1000000;
+    if (frac < 0)
+        frac += 1000000;
+    std::time_t secs = static_cast<std::time_t>((us - frac) / 1000000);
+    std::tm tm{};
+    gmtime_r(&secs, &tm);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "'%04d-%02d-%02d %02d:%02d:%02d.%06lld+00'",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                  frac);
+    return buf;
+}
+
+// Named queries plus the record of which backend has already prepared which of them.
+class QueryRepository
+{
+public:
+    explicit QueryRepository(std::vector<PreparedQuery> queries) : queries_(std::move(queries)) {}
+
+    const PreparedQuery &get(const std::string &name) const
+    {
+        for (const auto &q : queries_)
+        {
+            if (name == q.name)
+                return q;
+        }
+        throw std::out_of_range("Unknown query: " + name);
+    }
+
+    // Keyed by handle and backend pid: the pool may reconnect and reuse a PGconn address.
+    bool is_prepared(PGconn *conn, const PreparedQuery &query) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return prepared_.count(std::make_tuple(conn, PQbackendPID(conn), std::string(query.name))) != 0;
+    }
+
+    void mark_prepared(PGconn *conn, const PreparedQuery &query)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        prepared_.emplace(conn, PQbackendPID(conn), query.name);
+        ++prepares_;
+    }
+
+    size_t prepares() const { return prepares_; }
+
+    static std::string prepare_sql(const PreparedQuery &query)
+    {
+        std::string sql = "PREPARE ";
+        sql += query.name;
+        if (query.param_types[0] != '\0')
+        {
+            sql += " (";
+            sql += query.param_types;
+            sql += ")";
+        }
+        sql += " AS ";
+        sql += query.sql;
+        return sql;
+    }
+
+    template <typename... Args>
+    static std::string execute_sql(const PreparedQuery &query, const Args &...args)
+    {
+        std::string sql = "EXECUTE ";
+        sql += query.name;
+        if constexpr (sizeof...(Args) > 0)
+        {
+            sql += "(";
+            bool first = true;
+            ((sql += (first ? "" : ", "), sql += sql_literal(args), first = false), ...);
+            sql += ")";
+        }
+        return sql;
+    }
+
+private:
+    std::vector<PreparedQuery> queries_;
+    mutable std::mutex mutex_;
+    std::set<std::tuple<PGconn *, int, std::string>> prepared_;
+    std::atomic<size_t> prepares_{0};
+};
+
+// Like ozo::request, but runs `query` through its server-side prepared statement, issuing the
+// PREPARE first if the connection handed out by `provider` has not seen it yet. `timeout` covers
+// the whole request: getting the connection, the PREPARE and the EXECUTE share one deadline.
+template <typename Provider, typename Out, typename Handler, typename... Args>
+void request_prepared(QueryRepository &repo, Provider &&provider, const PreparedQuery &query,
+                      std::chrono::steady_clock::duration timeout, Out out, Handler handler, const Args &...args)
+{
+    std::string execute = QueryRepository::execute_sql(query, args...);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    ozo::get_connection(std::forward<Provider>(provider), ozo::deadline(deadline),
+                        [&repo, &query, execute = std::move(execute), deadline, out, handler = std::move(handler)](ozo::error_code ec, auto conn) mutable
+                        {
+                            if (ec)
+                            {
+                                handler(ec, std::move(conn));
+                                return;
+                            }
+                            if (repo.is_prepared(ozo::get_native_handle(conn), query))
+                            {
+                                ozo::request(std::move(conn), ozo::make_query(execute), ozo::deadline(deadline), out, std::move(handler));
+                                return;
+                            }
+                            ozo::execute(std::move(conn), ozo::make_query(QueryRepository::prepare_sql(query)), ozo::deadline(deadline),
+                                         [&repo, &query, execute = std::move(execute), deadline, out, handler = std::move(handler)](ozo::error_code ec, auto conn) mutable
+                                         {
+                                             if (ec)
+                                             {
+                                                 handler(ec, std::move(conn));
+                                                 return;
+                                             }
+                                             repo.mark_prepared(ozo::get_native_handle(conn), query);
+                                             ozo::request(std::move(conn), ozo::make_query(execute), ozo::deadline(deadline), out, std::move(handler));
+                                         });
+                        });
+}
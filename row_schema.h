@@ -0,0 +1,521 @@
+#pragma once
+
+// Compile-time row schemas.
+//
+// A table is described once as a list of typed columns; the row type, column count, CSV layout,
+// CREATE TABLE / INSERT statements and per-row parameter binding are all derived from that list.
+// Changing BlockSchema at the bottom of this file is enough to benchmark a wider or narrower
+// table with driver.cpp, driver_temp.cpp, block_index_bench.cpp and generator.cpp.
+//
+// Rows are flat std::tuples of fixed-size values (no heap), repeated column groups such as
+// hash_1..hash_31 are flattened into consecutive tuple elements.
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace schema {
+
+using bytes_view = std::basic_string_view<std::byte>; // same type as pqxx::bytes_view
+
+// --- Field types ---------------------------------------------------------------------------
+// Each type provides value_type, sql_type(), text_capacity (max text length), format(), parse()
+// and random(). Binary types are bound as binary parameters, the rest as text.
+
+namespace detail {
+
+// Howard Hinnant's days_from_civil / civil_from_days.
+constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline void civil_from_days(int64_t z, int64_t &y, unsigned &m, unsigned &d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+constexpr unsigned days_in_month(int64_t y, unsigned m) {
+    if (m == 2)
+        return (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 29 : 28;
+    return m == 4 || m == 6 || m == 9 || m == 11 ? 30 : 31;
+}
+
+inline void put_digits(char *out, int64_t v, int width) {
+    for (int i = width - 1; i >= 0; --i, v /= 10)
+        out[i] = static_cast<char>('0' + v % 10);
+}
+
+template <typename T>
+bool parse_number(std::string_view s, T &out) {
+    auto res = std::from_chars(s.data(), s.data() + s.size(), out);
+    return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace detail
+
+// timestamp without time zone, held as microseconds since the Unix epoch.
+struct Timestamp {
+    using value_type = int64_t;
+    static constexpr bool binary = false;
+    static constexpr size_t text_capacity = 26; // YYYY-MM-DD HH:MM:SS.ffffff
+    static std::string sql_type() { return "timestamp"; }
+
+    static size_t format(value_type us, char *out) {
+        int64_t secs = us >= 0 ? us / 1000000 : (us - 999999) / 1000000;
+        int64_t frac = us - secs * 1000000;
+        int64_t days = secs >= 0 ? secs / 86400 : (secs - 86399) / 86400;
+        int64_t tod = secs - days * 86400;
+        int64_t y;
+        unsigned m, d;
+        detail::civil_from_days(days, y, m, d);
+        detail::put_digits(out, y, 4);
+        out[4] = '-';
+        detail::put_digits(out + 5, m, 2);
+        out[7] = '-';
+        detail::put_digits(out + 8, d, 2);
+        out[10] = ' ';
+        detail::put_digits(out + 11, tod / 3600, 2);
+        out[13] = ':';
+        detail::put_digits(out + 14, tod / 60 % 60, 2);
+        out[16] = ':';
+        detail::put_digits(out + 17, tod % 60, 2);
+        if (frac == 0)
+            return 19;
+        out[19] = '.';
+        detail::put_digits(out + 20, frac, 6);
+        return 26;
+    }
+
+    // Rejects anything Postgres would not store as the same value: out-of-range fields, more
+    // than 6 fraction digits, trailing text such as a time zone. Also accepts the 32-character
+    // zero-padded hex row counter older generator.cpp builds wrote, mapped onto one row per
+    // second from 2020-01-01.
+    static bool parse(std::string_view s, value_type &out) {
+        if (s.size() >= 19 && s[4] == '-' && s[7] == '-' && (s[10] == ' ' || s[10] == 'T') && s[13] == ':' && s[16] == ':') {
+            unsigned y, mo, d, h, mi, sec;
+            if (!detail::parse_number(s.substr(0, 4), y) || !detail::parse_number(s.substr(5, 2), mo) ||
+                !detail::parse_number(s.substr(8, 2), d) || !detail::parse_number(s.substr(11, 2), h) ||
+                !detail::parse_number(s.substr(14, 2), mi) || !detail::parse_number(s.substr(17, 2), sec))
+                return false;
+            if (mo < 1 || mo > 12 || d < 1 || d > detail::days_in_month(y, mo) || h > 23 || mi > 59 || sec > 59)
+                return false;
+            uint32_t frac = 0;
+            if (s.size() > 19) {
+                std::string_view f = s.substr(20);
+                if (s[19] != '.' || f.empty() || f.size() > 6 || !detail::parse_number(f, frac))
+                    return false;
+                for (size_t i = f.size(); i < 6; ++i)
+                    frac *= 10;
+            }
+            out = ((detail::days_from_civil(y, mo, d) * 86400) + h * 3600 + mi * 60 + sec) * 1000000 + frac;
+            return true;
+        }
+        if (s.size() != 32)
+            return false;
+        uint64_t counter;
+        auto res = std::from_chars(s.data(), s.data() + s.size(), counter, 16);
+        if (res.ec != std::errc() || res.ptr != s.data() + s.size())
+            return false;
+        out = (1577836800 + static_cast<int64_t>(counter)) * 1000000;
+        return true;
+    }
+
+    // Whole seconds in 2020..2029; callers that need unique keys assign their own.
+    template <typename Rng>
+    static void random(Rng &rng, value_type &out) {
+        out = (1577836800 + static_cast<int64_t>(rng() % (10ULL * 365 * 86400))) * 1000000;
+    }
+};
+
+template <typename Int, const char *Sql>
+struct Integral {
+    using value_type = Int;
+    static constexpr bool binary = false;
+    static constexpr size_t text_capacity = std::numeric_limits<Int>::digits10 + 2;
+    static std::string sql_type() { return Sql; }
+    static size_t format(value_type v, char *out) {
+        return static_cast<size_t>(std::to_chars(out, out + text_capacity, v).ptr - out);
+    }
+    static bool parse(std::string_view s, value_type &out) { return detail::parse_number(s, out); }
+    template <typename Rng>
+    static void random(Rng &rng, value_type &out) { out = static_cast<Int>(rng()); }
+};
+
+inline constexpr char BIGINT_SQL[] = "bigint";
+inline constexpr char INTEGER_SQL[] = "integer";
+using BigInt = Integral<int64_t, BIGINT_SQL>;
+using Integer = Integral<int32_t, INTEGER_SQL>;
+
+struct Double {
+    using value_type = double;
+    static constexpr bool binary = false;
+    static constexpr size_t text_capacity = 32;
+    static std::string sql_type() { return "double precision"; }
+    static size_t format(value_type v, char *out) {
+        return static_cast<size_t>(std::to_chars(out, out + text_capacity, v).ptr - out);
+    }
+    static bool parse(std::string_view s, value_type &out) { return detail::parse_number(s, out); }
+    template <typename Rng>
+    static void random(Rng &rng, value_type &out) { out = std::uniform_real_distribution<double>(0, 1000)(rng); }
+};
+
+// char(N): exactly N characters, space padded.
+template <size_t N>
+struct FixedChar {
+    using value_type = std::array<char, N>;
+    static constexpr bool binary = false;
+    static constexpr size_t text_capacity = N;
+    static std::string sql_type() { return "char(" + std::to_string(N) + ")"; }
+    static size_t format(const value_type &v, char *out) {
+        std::memcpy(out, v.data(), N);
+        return N;
+    }
+    static bool parse(std::string_view s, value_type &out) {
+        if (s.size() > N)
+            return false;
+        std::memcpy(out.data(), s.data(), s.size());
+        std::memset(out.data() + s.size(), ' ', N - s.size());
+        return true;
+    }
+    // Lowercase hex digits, like generator.cpp's hash columns.
+    template <typename Rng>
+    static void random(Rng &rng, value_type &out) {
+        for (auto &c : out)
+            c = "0123456789abcdef"[rng() & 0xf];
+    }
+};
+
+// N raw bytes in a bytea column; bound as a binary parameter, "\x<hex>" in CSV.
+template <size_t N>
+struct FixedBinary {
+    using value_type = std::array<std::byte, N>;
+    static constexpr bool binary = true;
+    static constexpr size_t text_capacity = 2 + 2 * N;
+    static std::string sql_type() { return "bytea"; }
+    static size_t format(const value_type &v, char *out) {
+        static const char digits[] = "0123456789abcdef";
+        out[0] = '\\';
+        out[1] = 'x';
+        for (size_t i = 0; i < N; ++i) {
+            out[2 + 2 * i] = digits[std::to_integer<unsigned>(v[i]) >> 4];
+            out[3 + 2 * i] = digits[std::to_integer<unsigned>(v[i]) & 0xf];
+        }
+        return text_capacity;
+    }
+    static bool parse(std::string_view s, value_type &out) {
+        if (s.size() >= 2 && s[0] == '\\' && s[1] == 'x')
+            s.remove_prefix(2);
+        if (s.size() != 2 * N)
+            return false;
+        for (size_t i = 0; i < N; ++i) {
+            int hi = detail::hex_value(s[2 * i]), lo = detail::hex_value(s[2 * i + 1]);
+            if (hi < 0 || lo < 0)
+                return false;
+            out[i] = static_cast<std::byte>(hi << 4 | lo);
+        }
+        return true;
+    }
+    template <typename Rng>
+    static void random(Rng &rng, value_type &out) {
+        for (auto &b : out)
+            b = static_cast<std::byte>(rng());
+    }
+};
+
+// --- Columns -------------------------------------------------------------------------------
+// Derive from Column/Columns and add `static constexpr const char *name`. Columns<T, N> expands
+// to name_1..name_N.
+
+template <typename T>
+struct Column {
+    using type = T;
+    static constexpr size_t count = 1;
+};
+
+template <typename T, size_t N>
+struct Columns {
+    using type = T;
+    static constexpr size_t count = N;
+};
+
+namespace detail {
+
+template <size_t, typename T>
+using always = T;
+
+template <typename T, typename Seq>
+struct repeat;
+
+template <typename T, size_t... Is>
+struct repeat<T, std::index_sequence<Is...>> {
+    using type = std::tuple<always<Is, T>...>;
+};
+
+template <typename Col>
+using expand = typename repeat<typename Col::type, std::make_index_sequence<Col::count>>::type;
+
+// Text buffer layout for a row: where each non-binary field's text starts inside Binder's
+// buffer (last entry = total size), and the widest field for scratch buffers.
+template <typename Tuple>
+struct layout;
+
+template <typename... Fs>
+struct layout<std::tuple<Fs...>> {
+    static constexpr std::array<size_t, sizeof...(Fs) + 1> offsets() {
+        constexpr size_t caps[] = {(Fs::binary ? 0 : Fs::text_capacity)..., 0};
+        std::array<size_t, sizeof...(Fs) + 1> out{};
+        for (size_t i = 0; i < sizeof...(Fs); ++i)
+            out[i + 1] = out[i] + caps[i];
+        return out;
+    }
+
+    static constexpr size_t max_text_capacity() {
+        size_t m = 1;
+        ((m = Fs::text_capacity > m ? Fs::text_capacity : m), ...);
+        return m;
+    }
+};
+
+template <typename Tuple>
+struct values_of;
+
+template <typename... Fs>
+struct values_of<std::tuple<Fs...>> {
+    using type = std::tuple<typename Fs::value_type...>;
+};
+
+} // namespace detail
+
+// --- Table ---------------------------------------------------------------------------------
+// Derived must provide `static constexpr const char *table` and `primary_key` (nullptr for none).
+
+template <typename Derived, typename... Cols>
+struct Table {
+    using fields = decltype(std::tuple_cat(std::declval<detail::expand<Cols>>()...));
+    using Row = typename detail::values_of<fields>::type;
+    static constexpr size_t column_count = std::tuple_size_v<fields>;
+
+    template <size_t I>
+    using field_t = std::tuple_element_t<I, fields>;
+
+    static constexpr std::array<size_t, column_count + 1> text_offsets = detail::layout<fields>::offsets();
+    static constexpr size_t max_text_capacity = detail::layout<fields>::max_text_capacity();
+
+    static const std::vector<std::string> &column_names() {
+        static const std::vector<std::string> names = [] {
+            std::vector<std::string> out;
+            auto add = [&](const char *name, size_t count) {
+                for (size_t i = 1; i <= count; ++i)
+                    out.push_back(count == 1 ? std::string(name) : std::string(name) + "_" + std::to_string(i));
+            };
+            (add(Cols::name, Cols::count), ...);
+            return out;
+        }();
+        return names;
+    }
+
+    // Column definitions for CREATE TABLE; without the primary key for scratch copies of the table.
+    static std::string columns_sql(bool with_primary_key = true) {
+        std::string sql;
+        for_each_index([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if (I > 0)
+                sql += ", ";
+            sql += column_names()[I] + " " + field_t<I>::sql_type() + " NOT NULL";
+            if (with_primary_key && Derived::primary_key && column_names()[I] == Derived::primary_key)
+                sql += " PRIMARY KEY";
+        });
+        return sql;
+    }
+
+    static std::string create_table_sql() {
+        return std::string("CREATE TABLE IF NOT EXISTS ") + Derived::table + " (" + columns_sql() + ")";
+    }
+
+    static std::string insert_sql() {
+        std::string cols, vals;
+        for (size_t i = 0; i < column_count; ++i) {
+            cols += (i ? ", " : "") + column_names()[i];
+            vals += (i ? ", $" : "$") + std::to_string(i + 1);
+        }
+        return std::string("INSERT INTO ") + Derived::table + " (" + cols + ") VALUES (" + vals + ")";
+    }
+
+    static std::string csv_header() {
+        std::string out;
+        for (size_t i = 0; i < column_count; ++i)
+            out += (i ? "," : "") + column_names()[i];
+        return out;
+    }
+
+    static bool is_csv_header(std::string_view line) {
+        return line.substr(0, column_names()[0].size()) == column_names()[0];
+    }
+
+    // Calls f(std::integral_constant<size_t, I>) for every column.
+    template <typename F>
+    static void for_each_index(F &&f) {
+        for_each_index_impl(f, std::make_index_sequence<column_count>());
+    }
+
+    static Row parse_csv(std::string_view line) {
+        std::array<std::string_view, column_count> tokens;
+        size_t n = 0;
+        while (n < column_count) {
+            size_t comma = line.find(',');
+            tokens[n++] = line.substr(0, comma);
+            if (comma == std::string_view::npos)
+                break;
+            line.remove_prefix(comma + 1);
+            if (n == column_count)
+                n = column_count + 1; // more fields than columns
+        }
+        if (n != column_count)
+            throw std::runtime_error("Invalid CSV line: expected " + std::to_string(column_count) + " fields");
+        Row row;
+        for_each_index([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if (!field_t<I>::parse(tokens[I], std::get<I>(row)))
+                throw std::runtime_error("Invalid value for column " + column_names()[I] + ": " + std::string(tokens[I]));
+        });
+        return row;
+    }
+
+    // Fills every column with a random value of its type.
+    template <typename Rng>
+    static void randomize(Row &row, Rng &rng) {
+        for_each_index([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            field_t<I>::random(rng, std::get<I>(row));
+        });
+    }
+
+    static void append_csv(const Row &row, std::string &out) {
+        char buf[max_text_capacity];
+        for_each_index([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if (I > 0)
+                out += ',';
+            out.append(buf, field_t<I>::format(std::get<I>(row), buf));
+        });
+        out += '\n';
+    }
+
+    // Encodes one row into a fixed buffer sized from the schema and passes the fields to
+    // txn.exec_prepared (or a COPY stream) as a parameter pack: text fields as string views,
+    // binary fields as bytes_view pointing into the row (which must outlive the call).
+    class Binder {
+    public:
+        void encode(const Row &row) {
+            row_ = &row;
+            for_each_index([&](auto i) {
+                constexpr size_t I = decltype(i)::value;
+                if constexpr (!field_t<I>::binary)
+                    lengths_[I] = field_t<I>::format(std::get<I>(row), buffer_ + text_offsets[I]);
+            });
+        }
+
+        template <typename Txn>
+        auto exec_prepared(Txn &txn, const char *statement) const {
+            return exec_impl(txn, statement, std::make_index_sequence<column_count>());
+        }
+
+        // One COPY row for a pqxx::stream_to opened on the table's columns in schema order.
+        template <typename Stream>
+        void write_values(Stream &stream) const {
+            write_impl(stream, std::make_index_sequence<column_count>());
+        }
+
+        // Text form of column i for the last encoded row (binary columns as "\x<hex>").
+        std::string text(size_t i) const {
+            std::string out;
+            for_each_index([&](auto idx) {
+                constexpr size_t I = decltype(idx)::value;
+                if (I != i)
+                    return;
+                if constexpr (field_t<I>::binary) {
+                    char buf[field_t<I>::text_capacity];
+                    out.assign(buf, field_t<I>::format(std::get<I>(*row_), buf));
+                } else {
+                    out.assign(buffer_ + text_offsets[I], lengths_[I]);
+                }
+            });
+            return out;
+        }
+
+    private:
+        template <size_t I>
+        auto param() const {
+            if constexpr (field_t<I>::binary)
+                return bytes_view(std::get<I>(*row_).data(), std::get<I>(*row_).size());
+            else
+                return std::string_view(buffer_ + text_offsets[I], lengths_[I]);
+        }
+
+        template <typename Txn, size_t... Is>
+        auto exec_impl(Txn &txn, const char *statement, std::index_sequence<Is...>) const {
+            return txn.exec_prepared(statement, param<Is>()...);
+        }
+
+        template <typename Stream, size_t... Is>
+        void write_impl(Stream &stream, std::index_sequence<Is...>) const {
+            stream.write_values(param<Is>()...);
+        }
+
+        char buffer_[text_offsets[column_count] + 1];
+        std::array<size_t, column_count> lengths_{};
+        const Row *row_ = nullptr;
+    };
+
+private:
+    template <typename F, size_t... Is>
+    static void for_each_index_impl(F &f, std::index_sequence<Is...>) {
+        (f(std::integral_constant<size_t, Is>()), ...);
+    }
+};
+
+} // namespace schema
+
+// --- The block table used by the block drivers and generator.cpp ----------------------------
+
+struct BlockTimestamp : schema::Column<schema::Timestamp> {
+    static constexpr const char *name = "timestamp";
+};
+
+struct BlockHashes : schema::Columns<schema::FixedChar<32>, 31> {
+    static constexpr const char *name = "hash";
+};
+
+struct BlockSchema : schema::Table<BlockSchema, BlockTimestamp, BlockHashes> {
+    static constexpr const char *table = "block";
+    static constexpr const char *primary_key = "timestamp";
+};
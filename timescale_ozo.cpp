@@ -2,10 +2,12 @@
 
 #include <ozo/request.h>
 #include <ozo/connection_info.h>
+#include <ozo/connection_pool.h>
 #include <ozo/shortcuts.h>
 #include <boost/asio/io_context.hpp>
 #include <iostream>
 #include <chrono>
+#include "ozo_prepared.h"
 
 namespace asio = boost::asio;
 
@@ -18,6 +20,23 @@ int main()
         // Connection info
         ozo::connection_info conn_info("host=localhost port=5432 dbname=postgres user=postgres password=postgres");
 
+        // Connection pool, so prepared statements survive between requests
+        ozo::connection_pool_config pool_config;
+        pool_config.capacity = 2;
+        pool_config.queue_capacity = 16;
+        pool_config.idle_timeout = std::chrono::seconds(60);
+        auto pool = ozo::make_connection_pool(conn_info, pool_config);
+
+        // Named queries, PREPAREd once per pooled connection
+        QueryRepository queries({
+            {"insert_reading", "timestamptz, integer, double precision",
+             "INSERT INTO sensor_data (time, sensor_id, temperature) "
+             "VALUES ($1, $2, $3) "
+             "ON CONFLICT (sensor_id, time) DO NOTHING"},
+            {"latest_reading", "",
+             "SELECT time, sensor_id, temperature FROM sensor_data ORDER BY time DESC LIMIT 1"},
+        });
+
         // Create table query using query builder
         auto create_table_query = ozo::make_query(
             "CREATE TABLE IF NOT EXISTS bitcoin_data ("
@@ -85,62 +104,51 @@ int main()
         io.restart();
 
         // Insert sample data
-        auto insert_query = ozo::make_query(
-            "INSERT INTO sensor_data (time, sensor_id, temperature) "
-            "VALUES ($1, $2, $3) "
-            "ON CONFLICT (sensor_id, time) DO NOTHING",
-            std::chrono::system_clock::now(),
-            1,
-            25.5);
-
         ozo::rows_of<> result3;
 
-        ozo::request(conn_info[io], insert_query,
-                     ozo::deadline(std::chrono::seconds(30)),
-                     ozo::into(result3),
-                     [](ozo::error_code ec, auto conn)
-                     {
-                         if (!ec)
-                         {
-                             std::cout << "Data inserted successfully\n";
-                         }
-                         else
+        request_prepared(queries, pool[io], queries.get("insert_reading"), std::chrono::seconds(30),
+                         ozo::into(result3),
+                         [](ozo::error_code ec, auto conn)
                          {
-                             std::cerr << "Error inserting data: " << ec.message() << '\n';
-                         }
-                     });
+                             if (!ec)
+                             {
+                                 std::cout << "Data inserted successfully\n";
+                             }
+                             else
+                             {
+                                 std::cerr << "Error inserting data: " << ec.message() << '\n';
+                             }
+                         },
+                         std::chrono::system_clock::now(), int32_t{1}, 25.5);
 
         io.run();
         io.restart();
 
         // Query the inserted data
-        auto select_query = ozo::make_query("SELECT time, sensor_id, temperature FROM sensor_data ORDER BY time DESC LIMIT 1");
-
         ozo::rows_of<std::chrono::system_clock::time_point, int32_t, double> result4;
 
-        ozo::request(conn_info[io], select_query,
-                     ozo::deadline(std::chrono::seconds(30)),
-                     ozo::into(result4),
-                     [&result4](ozo::error_code ec, auto conn)
-                     {
-                         if (!ec)
+        request_prepared(queries, pool[io], queries.get("latest_reading"), std::chrono::seconds(30),
+                         ozo::into(result4),
+                         [&result4](ozo::error_code ec, auto conn)
                          {
-                             std::cout << "Query executed successfully\n";
-                             for (const auto &row : result4)
+                             if (!ec)
                              {
-                                 auto time = std::chrono::system_clock::to_time_t(std::get<0>(row));
-                                 std::cout << "Time: " << std::ctime(&time)
-                                           << "Sensor ID: " << std::get<1>(row)
-                                           << ", Temperature: " << std::get<2>(row) << std::endl;
+                                 std::cout << "Query executed successfully\n";
+                                 for (const auto &row : result4)
+                                 {
+                                     auto time = std::chrono::system_clock::to_time_t(std::get<0>(row));
+                                     std::cout << "Time: " << std::ctime(&time)
+                                               << "Sensor ID: " << std::get<1>(row)
+                                               << ", Temperature: " << std::get<2>(row) << std::endl;
+                                 }
                              }
-                         }
-                         else
-                         {
-                             std::cerr << "Error querying data: " << ec.message() << '\n';
-                             std::cerr << "Error category: " << ec.category().name() << '\n';
-                             std::cerr << "Error value: " << ec.value() << '\n';
-                         }
-                     });
+                             else
+                             {
+                                 std::cerr << "Error querying data: " << ec.message() << '\n';
+                                 std::cerr << "Error category: " << ec.category().name() << '\n';
+                                 std::cerr << "Error value: " << ec.value() << '\n';
+                             }
+                         });
 
         io.run();
     }
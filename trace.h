@@ -0,0 +1,233 @@
+#pragma once
+
+// Lightweight scoped tracing with Chrome trace-event JSON export (open in Perfetto or chrome://tracing).
+//
+// Each thread records into its own ring buffer, so recording is a clock read plus a store with no
+// locking; once full, the oldest events are overwritten. The ring grows on demand up to its
+// capacity (TRACE_EVENTS per thread, default 65536 events, ~3.5 MB), so short runs stay small.
+// It grows in fixed chunks that are never moved, so a recording thread never copies old events.
+// Tracing is off until trace::start() is called, and a disabled Span costs one relaxed atomic load.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trace {
+
+struct Event {
+    const char *name;               // string literal, never freed
+    const char *cat;
+    int64_t start_ns;
+    int64_t dur_ns;
+    const char *arg_name = nullptr; // optional single numeric argument
+    double arg = 0;
+    uint32_t tid = 0;               // 0 = recording thread, otherwise a virtual track
+};
+
+constexpr size_t CHUNK_EVENTS = 1024; // ~56 KB per allocation
+
+struct ThreadBuffer {
+    uint32_t tid;
+    std::string name;
+    std::vector<std::unique_ptr<Event[]>> chunks; // ring storage, added as it fills
+    size_t capacity = 0;
+    size_t size = 0;         // grows to `capacity`, then wraps
+    size_t next = 0;         // oldest event once the ring is full
+
+    Event &at(size_t i) { return chunks[i / CHUNK_EVENTS][i % CHUNK_EVENTS]; }
+    const Event &at(size_t i) const { return chunks[i / CHUNK_EVENTS][i % CHUNK_EVENTS]; }
+};
+
+struct Registry {
+    std::atomic<bool> enabled{false};
+    size_t capacity = 1 << 16;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<std::pair<uint32_t, std::string>> tracks; // virtual tracks, e.g. server-side samples
+};
+
+inline Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+inline bool enabled() {
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+// Only takes the registry lock the first time a thread records.
+inline ThreadBuffer &thread_buffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto owned = std::make_unique<ThreadBuffer>();
+        owned->tid = static_cast<uint32_t>(r.buffers.size() + 1);
+        owned->name = "thread " + std::to_string(owned->tid);
+        owned->capacity = r.capacity;
+        owned->chunks.reserve((r.capacity + CHUNK_EVENTS - 1) / CHUNK_EVENTS);
+        buffer = owned.get();
+        r.buffers.push_back(std::move(owned));
+    }
+    return *buffer;
+}
+
+// events_per_thread = 0 reads TRACE_EVENTS, falling back to 65536.
+inline void start(size_t events_per_thread = 0) {
+    Registry &r = registry();
+    if (events_per_thread == 0) {
+        const char *env = std::getenv("TRACE_EVENTS");
+        events_per_thread = env ? std::strtoull(env, nullptr, 10) : 0;
+    }
+    r.capacity = events_per_thread ? events_per_thread : 1 << 16;
+    r.epoch = std::chrono::steady_clock::now();
+    r.enabled.store(true);
+}
+
+inline void stop() {
+    registry().enabled.store(false);
+}
+
+inline void set_thread_name(const std::string &name) {
+    if (enabled())
+        thread_buffer().name = name;
+}
+
+// Declare an extra track (rendered as its own thread row) for events not timed on this thread.
+inline uint32_t add_track(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint32_t tid = static_cast<uint32_t>(100000 + r.tracks.size());
+    r.tracks.emplace_back(tid, name);
+    return tid;
+}
+
+inline void emit(const Event &event) {
+    ThreadBuffer &b = thread_buffer();
+    if (b.size < b.capacity) {
+        if (b.size % CHUNK_EVENTS == 0)
+            b.chunks.emplace_back(new Event[std::min(CHUNK_EVENTS, b.capacity - b.size)]);
+        b.at(b.size++) = event;
+        return;
+    }
+    if (b.capacity == 0)
+        return;
+    b.at(b.next) = event;
+    if (++b.next == b.capacity)
+        b.next = 0;
+}
+
+// Record a phase that started at `start_ns` and ends now.
+inline void record(const char *name, const char *cat, int64_t start_ns,
+                   const char *arg_name = nullptr, double arg = 0) {
+    if (!enabled())
+        return;
+    emit({name, cat, start_ns, now_ns() - start_ns, arg_name, arg, 0});
+}
+
+class Span {
+public:
+    Span(const char *name, const char *cat, const char *arg_name = nullptr, double arg = 0)
+        : name_(name), cat_(cat), arg_name_(arg_name), arg_(arg), start_(enabled() ? now_ns() : -1) {}
+    ~Span() {
+        if (start_ >= 0)
+            record(name_, cat_, start_, arg_name_, arg_);
+    }
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *name_;
+    const char *cat_;
+    const char *arg_name_;
+    double arg_;
+    int64_t start_;
+};
+
+inline void write_json_string(std::ostream &out, const std::string &s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+// Write every buffered event as Chrome trace-event JSON. Call after recording threads are done.
+// `metadata` entries land in "otherData" and show up in Perfetto's trace info.
+inline bool write_chrome_json(const std::string &path,
+                              const std::vector<std::pair<std::string, std::string>> &metadata = {}) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+
+    char num[64];
+    auto us = [&](int64_t ns) {
+        std::snprintf(num, sizeof(num), "%.3f", ns / 1000.0);
+        return std::string(num);
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{";
+    for (size_t i = 0; i < metadata.size(); ++i) {
+        if (i)
+            out << ',';
+        write_json_string(out, metadata[i].first);
+        out << ':';
+        write_json_string(out, metadata[i].second);
+    }
+    out << "},\"traceEvents\":[\n";
+
+    bool first = true;
+    auto thread_name = [&](uint32_t tid, const std::string &name) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":";
+        write_json_string(out, name);
+        out << "}}";
+        first = false;
+    };
+    for (const auto &b : r.buffers)
+        thread_name(b->tid, b->name);
+    for (const auto &t : r.tracks)
+        thread_name(t.first, t.second);
+
+    for (const auto &b : r.buffers) {
+        size_t count = b->size;
+        size_t begin = b->next;
+        for (size_t i = 0; i < count; ++i) {
+            const Event &e = b->at((begin + i) % count);
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << (e.tid ? e.tid : b->tid)
+                << ",\"name\":\"" << e.name << "\",\"cat\":\"" << e.cat << "\""
+                << ",\"ts\":" << us(e.start_ns) << ",\"dur\":" << us(e.dur_ns);
+            if (e.arg_name) {
+                std::snprintf(num, sizeof(num), "%.6g", e.arg);
+                out << ",\"args\":{\"" << e.arg_name << "\":" << num << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace trace
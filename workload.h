@@ -0,0 +1,274 @@
+#pragma once
+
+// Compact binary workload traces: what each client issued against the block /
+// bitcoin_transactions tables, when, on which session and with which parameters.
+//
+// File:   "TSWL" | varint version
+// Record: u8 op | zigzag varint delta of intended time (us, vs previous record) | varint session
+//         | varint param count | params
+// Param:  u8 tag, then  INT: zigzag varint | DOUBLE: 8 bytes | TEXT: varint len + bytes
+//                       DEFINE: like TEXT, and appended to the string table | REF: varint table index
+//
+// Callers intern values that repeat (wallet addresses) and write one-off values (hashes) inline.
+// Integers are little-endian; the format assumes a little-endian host for doubles.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace workload {
+
+enum class Op : uint8_t {
+    InsertBlock = 1,        // one text param per BlockSchema column (row_schema.h)
+    ScanBlock = 2,          // full ordered scan
+    RandomBlock = 3,        // ORDER BY random() LIMIT 1
+    LatestBlock = 4,        // newest row
+    RangeBlock = 5,         // timestamp BETWEEN $1 AND $2
+    InsertTransaction = 16, // timestamp, source, destination, satoshi
+    LatestTransactions = 17 // newest $1 rows
+};
+
+inline const char *op_name(Op op) {
+    switch (op) {
+    case Op::InsertBlock: return "insert_block";
+    case Op::ScanBlock: return "scan_block";
+    case Op::RandomBlock: return "random_block";
+    case Op::LatestBlock: return "latest_block";
+    case Op::RangeBlock: return "range_block";
+    case Op::InsertTransaction: return "insert_transaction";
+    case Op::LatestTransactions: return "latest_transactions";
+    }
+    return "unknown";
+}
+
+struct Param {
+    enum Kind : uint8_t { Null = 0, Int = 1, Double = 2, Text = 3 };
+    Kind kind = Null;
+    bool interned = false; // writer hint: store in the string table
+    int64_t i = 0;
+    double d = 0;
+    std::string s;
+
+    static Param null() { return {}; }
+    static Param integer(int64_t v) { Param p; p.kind = Int; p.i = v; return p; }
+    static Param real(double v) { Param p; p.kind = Double; p.d = v; return p; }
+    static Param text(std::string v, bool intern = false) {
+        Param p;
+        p.kind = Text;
+        p.interned = intern;
+        p.s = std::move(v);
+        return p;
+    }
+};
+
+struct Record {
+    Op op;
+    int64_t time_us;  // intended issue time, unix epoch microseconds
+    uint32_t session; // client connection/thread that issued it
+    std::vector<Param> params;
+};
+
+enum Tag : uint8_t { TagNull = 0, TagInt = 1, TagDouble = 2, TagText = 3, TagDefine = 4, TagRef = 5 };
+
+inline const char MAGIC[4] = {'T', 'S', 'W', 'L'};
+const uint64_t VERSION = 1;
+
+inline int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Thread-safe append-only trace writer.
+class Writer {
+public:
+    explicit Writer(const std::string &path) : out_(path, std::ios::binary) {
+        if (!out_.is_open())
+            throw std::runtime_error("Could not open workload file " + path);
+        out_.write(MAGIC, sizeof(MAGIC));
+        put_varint(VERSION);
+    }
+
+    void write(Op op, uint32_t session, const std::vector<Param> &params, int64_t time_us = now_us()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        put_byte(static_cast<uint8_t>(op));
+        put_varint(zigzag(time_us - last_us_));
+        last_us_ = time_us;
+        put_varint(session);
+        put_varint(params.size());
+        for (const auto &p : params)
+            put_param(p);
+        ++records_;
+    }
+
+    size_t records() const { return records_; }
+    void flush() { out_.flush(); }
+
+private:
+    static uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+
+    void put_byte(uint8_t b) { out_.put(static_cast<char>(b)); }
+
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            put_byte(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        put_byte(static_cast<uint8_t>(v));
+    }
+
+    void put_string(const std::string &s) {
+        put_varint(s.size());
+        out_.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    void put_param(const Param &p) {
+        switch (p.kind) {
+        case Param::Null:
+            put_byte(TagNull);
+            break;
+        case Param::Int:
+            put_byte(TagInt);
+            put_varint(zigzag(p.i));
+            break;
+        case Param::Double: {
+            put_byte(TagDouble);
+            char buf[sizeof(double)];
+            std::memcpy(buf, &p.d, sizeof(buf));
+            out_.write(buf, sizeof(buf));
+            break;
+        }
+        case Param::Text: {
+            if (!p.interned) {
+                put_byte(TagText);
+                put_string(p.s);
+                break;
+            }
+            auto it = strings_.find(p.s);
+            if (it != strings_.end()) {
+                put_byte(TagRef);
+                put_varint(it->second);
+            } else {
+                put_byte(TagDefine);
+                put_string(p.s);
+                strings_.emplace(p.s, static_cast<uint32_t>(strings_.size()));
+            }
+            break;
+        }
+        }
+    }
+
+    std::ofstream out_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> strings_;
+    int64_t last_us_ = 0;
+    size_t records_ = 0;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string &path) : in_(path, std::ios::binary) {
+        if (!in_.is_open())
+            throw std::runtime_error("Could not open workload file " + path);
+        char magic[sizeof(MAGIC)];
+        if (!in_.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw std::runtime_error(path + " is not a workload trace");
+        if (get_varint() != VERSION)
+            throw std::runtime_error(path + ": unsupported workload trace version");
+    }
+
+    // Returns false at end of file; throws on a truncated or corrupt record.
+    bool next(Record &rec) {
+        int c = in_.get();
+        if (c == std::char_traits<char>::eof())
+            return false;
+        rec.op = static_cast<Op>(c);
+        last_us_ += unzigzag(get_varint());
+        rec.time_us = last_us_;
+        rec.session = static_cast<uint32_t>(get_varint());
+        rec.params.resize(get_varint());
+        for (auto &p : rec.params)
+            get_param(p);
+        return true;
+    }
+
+private:
+    static int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+    uint8_t get_byte() {
+        int c = in_.get();
+        if (c == std::char_traits<char>::eof())
+            throw std::runtime_error("Truncated workload trace");
+        return static_cast<uint8_t>(c);
+    }
+
+    uint64_t get_varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = get_byte();
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Corrupt varint in workload trace");
+    }
+
+    std::string get_string() {
+        std::string s(get_varint(), '\0');
+        if (!in_.read(s.data(), static_cast<std::streamsize>(s.size())))
+            throw std::runtime_error("Truncated workload trace");
+        return s;
+    }
+
+    void get_param(Param &p) {
+        p = Param();
+        switch (get_byte()) {
+        case TagNull:
+            break;
+        case TagInt:
+            p.kind = Param::Int;
+            p.i = unzigzag(get_varint());
+            break;
+        case TagDouble: {
+            char buf[sizeof(double)];
+            if (!in_.read(buf, sizeof(buf)))
+                throw std::runtime_error("Truncated workload trace");
+            p.kind = Param::Double;
+            std::memcpy(&p.d, buf, sizeof(buf));
+            break;
+        }
+        case TagText:
+            p.kind = Param::Text;
+            p.s = get_string();
+            break;
+        case TagDefine:
+            p.kind = Param::Text;
+            p.interned = true;
+            p.s = get_string();
+            strings_.push_back(p.s);
+            break;
+        case TagRef: {
+            uint64_t idx = get_varint();
+            if (idx >= strings_.size())
+                throw std::runtime_error("Bad string reference in workload trace");
+            p.kind = Param::Text;
+            p.interned = true;
+            p.s = strings_[idx];
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown parameter tag in workload trace");
+        }
+    }
+
+    std::ifstream in_;
+    std::vector<std::string> strings_;
+    int64_t last_us_ = 0;
+};
+
+} // namespace workload